@@ -2,7 +2,7 @@
  * ============================================================
  *   PLANO CARTESIANO 2D -- k-NN & Clustering  [v3]
  * ============================================================
- *  Lenguaje : C++
+ *  Lenguaje : C++20
  * ============================================================
  */
 
@@ -15,6 +15,21 @@
 #include <limits>
 #include <random>
 #include <sstream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <queue>
+#include <atomic>
+#include <cstdint>
+#include <charconv>
+#include <string_view>
+#include <unordered_set>
+#include <unordered_map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <coroutine>
 
 // ============================================================
 //  CONSTANTES
@@ -26,8 +41,18 @@ static const int AXIS_X_MAX =  10;
 static const int AXIS_Y_MIN = -7;
 static const int AXIS_Y_MAX =  7;
 static const int MAX_ITER   = 300;
+static const int MAX_GROUPS = 10000; // limite de k (independiente de los simbolos)
+static const int CENTROID_INDEX_MIN_K = 32; // desde aqui se indexan los centroides
 static const int MENU_W     = 44;   // ancho barra de menu lateral
+static const int PAR_MIN_CHUNK   = 2048;  // elementos minimos por hilo
+static const int KNN_GRAPH_BLOCK = 65536; // puntos por bloque al escribir el grafo
+static const int IMPORT_CHUNK_BYTES = 1 << 20;  // bytes por bloque de importacion
+static const int NAMES_PREVIEW   = 20;    // nombres mostrados en la barra de estado
+static const int QUERY_CACHE_SIZE = 256;  // resultados guardados en la cache LRU
+static const int POOL_MIN_THREADS = 2;    // hilos minimos del pool asincrono
+static const double QUANT_MARGIN = 2.0 * 1.41421356237 + 1e-3; // error max de distancia en pasos de cuantizacion
 
+// Los simbolos se reutilizan en ciclo cuando hay mas grupos que simbolos
 static const std::vector<char> GROUP_SYMBOLS = {
     'o', '#', '@', 'S', '%', '&', 'V', '?', 'Z', 'W'
 };
@@ -63,6 +88,31 @@ double euclideanDistance(const Point& a, const Point& b) {
     return std::sqrt(dx*dx + dy*dy);
 }
 
+// ============================================================
+//  EJECUCION PARALELA
+// ============================================================
+/*
+ * Reparte el rango [0, n) en bloques contiguos, uno por hilo.
+ * Con pocos elementos corre todo en el hilo actual: crear
+ * hilos para datasets educativos cuesta mas que el trabajo.
+ * 'grain' = elementos minimos por hilo (1 si cada elemento ya
+ * es un trabajo grande, p. ej. un bloque de archivo).
+ */
+template <typename F>
+void parallelFor(int n, F f, int grain = PAR_MIN_CHUNK) {
+    int hw = (int)std::thread::hardware_concurrency();
+    int nt = std::max(1, std::min(hw > 0 ? hw : 2, n / std::max(1, grain)));
+    if (nt == 1) { for (int i = 0; i < n; ++i) f(i); return; }
+    std::vector<std::thread> th;
+    int chunk = (n + nt - 1) / nt;
+    for (int t = 0; t < nt; ++t) {
+        int b = t * chunk, e = std::min(n, b + chunk);
+        if (b >= e) break;
+        th.emplace_back([b, e, &f]() { for (int i = b; i < e; ++i) f(i); });
+    }
+    for (auto& t : th) t.join();
+}
+
 // ============================================================
 //  MAPEADO DE COORDENADAS -> CELDA DEL CANVAS
 // ============================================================
@@ -199,9 +249,12 @@ void drawPlane(const std::vector<Point>& points,
     std::cout << "+\n";
     // Leyenda
     if (!groups.empty()) {
+        int shown = std::min((int)groups.size(), (int)GROUP_SYMBOLS.size());
         std::cout << "  Leyenda:";
-        for (int i = 0; i < (int)groups.size(); ++i)
+        for (int i = 0; i < shown; ++i)
             std::cout << "  [" << groups[i].symbol << "]=" << groups[i].name;
+        if (shown < (int)groups.size())
+            std::cout << "  ... (+" << groups.size() - shown << ", simbolos repetidos)";
         std::cout << "\n";
     }
     std::cout << "  Grid '.': cada entero | '+': interseccion de ejes/grilla\n\n";
@@ -262,41 +315,286 @@ void printKNN(const Point& q, const std::vector<DistancePair>& nb) {
                   << nb[0].distance << ")\n";
 }
 
+// ============================================================
+//  INDICE ESPACIAL (KD-TREE)  O(n log n) construccion
+// ============================================================
+/*
+ * Arbol k-d implicito sobre un arreglo: en cada rango [lo, hi)
+ * el nodo del medio (mid) es el punto de corte, segun el eje
+ * (X o Y) donde el rango esta mas extendido; a su izquierda
+ * quedan los menores o iguales y a su derecha los mayores o
+ * iguales (nth_element). No hay tamano de celda, asi que un
+ * punto muy lejano no cambia el costo de las consultas.
+ *
+ * Los puntos con coordenadas no finitas (inf, nan) no se
+ * indexan; 'skipped' dice cuantos se omitieron.
+ */
+struct KdTree {
+    struct Node { double x, y; int id; };
+    std::vector<Node> nodes;
+    std::vector<unsigned char> axis;   // eje de corte de cada mid (0 = X, 1 = Y)
+    int skipped = 0;
+
+    bool empty() const { return nodes.empty(); }
+
+    void build(const std::vector<Point>& pts) {
+        nodes.clear(); skipped = 0;
+        nodes.reserve(pts.size());
+        for (int i = 0; i < (int)pts.size(); ++i) {
+            if (std::isfinite(pts[i].x) && std::isfinite(pts[i].y))
+                nodes.push_back({pts[i].x, pts[i].y, i});
+            else skipped++;
+        }
+        axis.assign(nodes.size(), 0);
+        buildRange(0, (int)nodes.size());
+    }
+
+    void buildRange(int lo, int hi) {
+        if (hi - lo <= 1) return;
+        double x0 = nodes[lo].x, x1 = x0, y0 = nodes[lo].y, y1 = y0;
+        for (int i = lo + 1; i < hi; ++i) {
+            x0 = std::min(x0, nodes[i].x); x1 = std::max(x1, nodes[i].x);
+            y0 = std::min(y0, nodes[i].y); y1 = std::max(y1, nodes[i].y);
+        }
+        unsigned char ax = (x1 - x0 >= y1 - y0) ? 0 : 1;
+        int mid = (lo + hi) / 2;
+        std::nth_element(nodes.begin() + lo, nodes.begin() + mid, nodes.begin() + hi,
+            [ax](const Node& a, const Node& b) { return ax ? a.y < b.y : a.x < b.x; });
+        axis[mid] = ax;
+        buildRange(lo, mid);
+        buildRange(mid + 1, hi);
+    }
+
+    // Llama f(id, d2) para cada punto a distancia <= r de (x, y)
+    template <typename F>
+    void forEachInRadius(double x, double y, double r, F f) const {
+        radiusRange(0, (int)nodes.size(), x, y, r * r, f);
+    }
+
+    template <typename F>
+    void radiusRange(int lo, int hi, double x, double y, double r2, F& f) const {
+        if (lo >= hi) return;
+        int mid = (lo + hi) / 2;
+        const Node& n = nodes[mid];
+        double dx = n.x - x, dy = n.y - y;
+        double d2 = dx*dx + dy*dy;
+        if (d2 <= r2) f(n.id, d2);
+        double diff = axis[mid] ? y - n.y : x - n.x;
+        if (diff <= 0 || diff*diff <= r2) radiusRange(lo, mid, x, y, r2, f);
+        if (diff >= 0 || diff*diff <= r2) radiusRange(mid + 1, hi, x, y, r2, f);
+    }
+
+    /*
+     * k vecinos mas cercanos a (x, y), ordenados por distancia.
+     * Baja primero por el lado del corte donde cae el query; el
+     * otro lado solo se visita si el plano de corte esta mas
+     * cerca que el k-esimo mejor. 'exclude' omite un indice.
+     */
+    typedef std::priority_queue<std::pair<double,int>> MaxHeap;   // max-heap de d2
+
+    std::vector<std::pair<double,int>> nearest(double x, double y, int k,
+                                               int exclude = -1) const {
+        std::vector<std::pair<double,int>> out;
+        if (empty() || k <= 0) return out;
+        MaxHeap heap;
+        nearestRange(0, (int)nodes.size(), x, y, k, exclude, heap);
+        out.resize(heap.size());
+        for (int i = (int)out.size() - 1; i >= 0; --i) {
+            out[i] = {std::sqrt(heap.top().first), heap.top().second};
+            heap.pop();
+        }
+        return out;
+    }
+
+    void nearestRange(int lo, int hi, double x, double y, int k, int exclude,
+                      MaxHeap& heap) const {
+        if (lo >= hi) return;
+        int mid = (lo + hi) / 2;
+        const Node& n = nodes[mid];
+        if (n.id != exclude) {
+            double dx = n.x - x, dy = n.y - y;
+            double d2 = dx*dx + dy*dy;
+            if ((int)heap.size() < k) heap.push({d2, n.id});
+            else if (d2 < heap.top().first) { heap.pop(); heap.push({d2, n.id}); }
+        }
+        double diff = axis[mid] ? y - n.y : x - n.x;
+        bool leftFirst = diff < 0;
+        if (leftFirst) nearestRange(lo, mid, x, y, k, exclude, heap);
+        else           nearestRange(mid + 1, hi, x, y, k, exclude, heap);
+        if ((int)heap.size() < k || diff*diff < heap.top().first) {
+            if (leftFirst) nearestRange(mid + 1, hi, x, y, k, exclude, heap);
+            else           nearestRange(lo, mid, x, y, k, exclude, heap);
+        }
+    }
+};
+
+// Avisa cuantos puntos tienen alguna coordenada inf/nan (los indices los omiten)
+void reportNonFinite(const std::vector<Point>& pts) {
+    int c = 0;
+    for (const auto& p : pts) if (!std::isfinite(p.x) || !std::isfinite(p.y)) c++;
+    if (c > 0)
+        std::cout << "  [!] " << c << " punto(s) con coordenadas no finitas omitido(s).\n";
+}
+
+// ============================================================
+//  PAR MAS CERCANO (DIVIDE Y VENCERAS)  O(n log n)
+// ============================================================
+/*
+ * idx[lo, hi) llega ordenado por X y sale ordenado por Y
+ * (merge como en merge sort), asi la franja central se revisa
+ * en orden de Y sin volver a ordenar: O(n log n) en total.
+ * Dentro de la franja cada punto solo se compara con los que
+ * estan a menos de 'best' en Y (a lo sumo 7).
+ * Los puntos con coordenadas no finitas no participan; si
+ * quedan menos de 2, a = b = -1.
+ */
+struct ClosestPairResult {
+    int a = -1, b = -1;
+    double distance = std::numeric_limits<double>::max();
+};
+
+void closestPairRec(const std::vector<Point>& pts, std::vector<int>& idx,
+                    std::vector<int>& tmp, int lo, int hi, ClosestPairResult& best) {
+    auto byY = [&](int i, int j) { return pts[i].y < pts[j].y; };
+    auto test = [&](int i, int j) {
+        double d = euclideanDistance(pts[i], pts[j]);
+        if (d < best.distance) { best.distance = d; best.a = i; best.b = j; }
+    };
+    if (hi - lo <= 3) {
+        for (int i = lo; i < hi; ++i)
+            for (int j = i + 1; j < hi; ++j) test(idx[i], idx[j]);
+        std::sort(idx.begin() + lo, idx.begin() + hi, byY);
+        return;
+    }
+    int mid = (lo + hi) / 2;
+    double midX = pts[idx[mid]].x;
+    closestPairRec(pts, idx, tmp, lo, mid, best);
+    closestPairRec(pts, idx, tmp, mid, hi, best);
+    std::merge(idx.begin() + lo, idx.begin() + mid, idx.begin() + mid, idx.begin() + hi,
+               tmp.begin() + lo, byY);
+    std::copy(tmp.begin() + lo, tmp.begin() + hi, idx.begin() + lo);
+
+    // Franja |x - midX| < best, reutilizando tmp como buffer
+    int m = lo;
+    for (int i = lo; i < hi; ++i)
+        if (std::fabs(pts[idx[i]].x - midX) < best.distance) tmp[m++] = idx[i];
+    for (int i = lo; i < m; ++i)
+        for (int j = i + 1; j < m && pts[tmp[j]].y - pts[tmp[i]].y < best.distance; ++j)
+            test(tmp[i], tmp[j]);
+}
+
+ClosestPairResult closestPair(const std::vector<Point>& pts) {
+    ClosestPairResult best;
+    std::vector<int> idx;
+    idx.reserve(pts.size());
+    for (int i = 0; i < (int)pts.size(); ++i)
+        if (std::isfinite(pts[i].x) && std::isfinite(pts[i].y)) idx.push_back(i);
+    int n = (int)idx.size();
+    if (n < 2) return best;
+    std::vector<int> tmp(n);
+    std::sort(idx.begin(), idx.end(),
+        [&](int i, int j){ return pts[i].x < pts[j].x; });
+    closestPairRec(pts, idx, tmp, 0, n, best);
+    return best;
+}
+
+// ============================================================
+//  GRAFO k-NN DE TODOS LOS PUNTOS  (paralelo sobre KdTree)
+// ============================================================
+/*
+ * Calcula los k vecinos de cada punto usando el kd-tree y
+ * escribe una arista por linea:  origen,vecino,orden,distancia
+ * Los puntos con coordenadas no finitas no generan aristas.
+ * Se procesa por bloques de KNN_GRAPH_BLOCK puntos: cada bloque
+ * se resuelve en paralelo y se vuelca al stream antes de pasar
+ * al siguiente, asi la memoria no crece con n.
+ * Devuelve el numero de aristas escritas.
+ */
+long long writeKNNGraph(const std::vector<Point>& pts, int k, std::ostream& out) {
+    int n = (int)pts.size();
+    if (n < 2 || k < 1) return 0;
+    k = std::min(k, n - 1);
+    KdTree tree;
+    tree.build(pts);
+    long long edges = 0;
+    std::vector<std::vector<std::pair<double,int>>> res;
+    out << "origen,vecino,orden,distancia\n";
+    for (int b0 = 0; b0 < n; b0 += KNN_GRAPH_BLOCK) {
+        int b1 = std::min(n, b0 + KNN_GRAPH_BLOCK);
+        res.assign(b1 - b0, {});
+        parallelFor(b1 - b0, [&](int i) {
+            const Point& p = pts[b0 + i];
+            if (std::isfinite(p.x) && std::isfinite(p.y))
+                res[i] = tree.nearest(p.x, p.y, k, b0 + i);
+        });
+        for (int i = 0; i < b1 - b0; ++i)
+            for (int r = 0; r < (int)res[i].size(); ++r) {
+                out << pts[b0 + i].name << ',' << pts[res[i][r].second].name << ','
+                    << (r + 1) << ',' << std::fixed << std::setprecision(6)
+                    << res[i][r].first << '\n';
+                ++edges;
+            }
+    }
+    return edges;
+}
+
 // ============================================================
 //  K-MEANS  O(I*k*n)
 // ============================================================
-std::vector<Group> kMeans(std::vector<Point>& pts, int k) {
+/*
+ * Control opcional para correr K-Means en segundo plano: el hilo
+ * que lo lanza puede leer el avance y pedir que se detenga al
+ * terminar la iteracion en curso. Con control no se imprime nada
+ * (la consola es del hilo principal).
+ */
+struct KMeansControl {
+    std::atomic<bool> cancel{false};
+    std::atomic<bool> converged{false};
+    std::atomic<int>  iteration{0};
+    std::atomic<int>  moved{0};      // puntos que cambiaron de grupo en la ultima iteracion
+};
+
+// Registra el avance; devuelve true si hay que detenerse
+bool kMeansStep(KMeansControl* ctl, int it, int moved) {
+    if (!ctl) {
+        if (!moved) std::cout << "  K-Means convergio en iteracion " << it+1 << "\n";
+        return !moved;
+    }
+    ctl->iteration = it + 1;
+    ctl->moved = moved;
+    if (!moved) ctl->converged = true;
+    return !moved || ctl->cancel;
+}
+
+// Inicializacion K-Means++ (comun a kMeans y kMeansCompact).
+// 'best' guarda la distancia al centroide mas cercano ya elegido
+// y solo se compara contra el ultimo agregado: O(k*n) en total.
+// Si se pide cancelar devuelve menos de k centroides.
+std::vector<Point> kMeansPlusPlus(const std::vector<Point>& pts, int k, std::mt19937& rng,
+                                  const KMeansControl* ctl = nullptr) {
     int n = (int)pts.size();
-    if (k <= 0 || n == 0) return {};
-    if (k > n) k = n;
-    std::mt19937 rng(42);
     std::vector<Point> cents;
     std::uniform_int_distribution<int> pick(0, n-1);
     cents.push_back(pts[pick(rng)]);
+    std::vector<double> best(n, std::numeric_limits<double>::max()), d2(n);
     for (int c = 1; c < k; ++c) {
-        std::vector<double> d2(n); double tot = 0;
+        if (ctl && ctl->cancel) break;
+        double tot = 0;
         for (int i = 0; i < n; ++i) {
-            double best = std::numeric_limits<double>::max();
-            for (auto& ct : cents) { double d = euclideanDistance(pts[i],ct); best=std::min(best,d); }
-            d2[i] = best*best; tot += d2[i];
+            best[i] = std::min(best[i], euclideanDistance(pts[i], cents.back()));
+            d2[i] = best[i]*best[i]; tot += d2[i];
         }
         std::uniform_real_distribution<double> spin(0, tot);
         double tgt = spin(rng), acc = 0; int ch = 0;
         for (int i = 0; i < n; ++i) { acc += d2[i]; if (acc >= tgt){ ch=i; break; } }
         cents.push_back(pts[ch]);
     }
-    for (int it = 0; it < MAX_ITER; ++it) {
-        bool changed = false;
-        for (auto& p : pts) {
-            int best = 0; double bD = euclideanDistance(p, cents[0]);
-            for (int c = 1; c < k; ++c) { double d = euclideanDistance(p,cents[c]); if(d<bD){bD=d;best=c;} }
-            if (p.groupId != best) { p.groupId = best; changed = true; }
-        }
-        if (!changed) { std::cout << "  K-Means convergio en iteracion " << it+1 << "\n"; break; }
-        std::vector<double> sx(k,0), sy(k,0); std::vector<int> cnt(k,0);
-        for (auto& p : pts) { sx[p.groupId]+=p.x; sy[p.groupId]+=p.y; cnt[p.groupId]++; }
-        for (int c = 0; c < k; ++c) if (cnt[c]) { cents[c].x=sx[c]/cnt[c]; cents[c].y=sy[c]/cnt[c]; }
-    }
+    return cents;
+}
+
+// Empaqueta centroides como grupos con nombre y simbolo
+std::vector<Group> buildGroups(const std::vector<Point>& cents) {
+    int k = (int)cents.size();
     std::vector<Group> gs(k);
     for (int c = 0; c < k; ++c) {
         gs[c].name    = "Grupo-" + std::to_string(c+1);
@@ -307,25 +605,386 @@ std::vector<Group> kMeans(std::vector<Point>& pts, int k) {
     return gs;
 }
 
+std::vector<Group> kMeans(std::vector<Point>& pts, int k, KMeansControl* ctl = nullptr) {
+    int n = (int)pts.size();
+    if (k <= 0 || n == 0) return {};
+    if (k > n) k = n;
+    std::mt19937 rng(42);
+    std::vector<Point> cents = kMeansPlusPlus(pts, k, rng, ctl);
+    if ((int)cents.size() < k) return {};   // cancelado durante la inicializacion
+    bool useIndex = k >= CENTROID_INDEX_MIN_K;
+    KdTree cIdx;
+    for (int it = 0; it < MAX_ITER; ++it) {
+        int changed = 0;
+        if (useIndex) cIdx.build(cents);   // una vez por iteracion
+        for (auto& p : pts) {
+            int best = 0;
+            if (useIndex && !cIdx.empty()) best = cIdx.nearest(p.x, p.y, 1)[0].second;
+            else {
+                double bD = euclideanDistance(p, cents[0]);
+                for (int c = 1; c < k; ++c) { double d = euclideanDistance(p,cents[c]); if(d<bD){bD=d;best=c;} }
+            }
+            if (p.groupId != best) { p.groupId = best; changed++; }
+        }
+        if (kMeansStep(ctl, it, changed)) break;
+        std::vector<double> sx(k,0), sy(k,0); std::vector<int> cnt(k,0);
+        for (auto& p : pts) { sx[p.groupId]+=p.x; sy[p.groupId]+=p.y; cnt[p.groupId]++; }
+        for (int c = 0; c < k; ++c) if (cnt[c]) { cents[c].x=sx[c]/cnt[c]; cents[c].y=sy[c]/cnt[c]; }
+    }
+    return buildGroups(cents);
+}
+
 void printClusterStats(const std::vector<Point>& pts, const std::vector<Group>& gs) {
     std::cout << "\n  +----------------+--------+---------------------------+\n"
               << "  |     Grupo      | Puntos |       Centroide           |\n"
               << "  +----------------+--------+---------------------------+\n";
-    for (int i = 0; i < (int)gs.size(); ++i) {
-        int cnt = 0; for (auto& p:pts) if(p.groupId==i) cnt++;
+    std::vector<int> counts(gs.size(), 0);
+    for (auto& p : pts) if (p.groupId >= 0 && p.groupId < (int)gs.size()) counts[p.groupId]++;
+    int shown = std::min((int)gs.size(), NAMES_PREVIEW);
+    for (int i = 0; i < shown; ++i) {
+        int cnt = counts[i];
         std::cout << "  | " << std::left  << std::setw(14) << gs[i].name << " | "
                   << std::right << std::setw(6) << cnt << " | ("
                   << std::fixed << std::setprecision(2)
                   << std::setw(6) << gs[i].centroid.x << ", "
                   << std::setw(6) << gs[i].centroid.y << ")           |\n";
     }
-    std::cout << "  +----------------+--------+---------------------------+\n\n";
+    std::cout << "  +----------------+--------+---------------------------+\n";
+    if (shown < (int)gs.size())
+        std::cout << "  ... (+" << gs.size() - shown << " grupos)\n";
+    std::cout << "\n";
+}
+
+// ============================================================
+//  MODO COMPACTO: COORDENADAS CUANTIZADAS (16 / 32 bits)
+// ============================================================
+/*
+ * Copia las coordenadas en enteros sin signo de punto fijo
+ * relativos a la caja del dataset:  q = round((x - minX) / step).
+ * Se usa el mismo 'step' en X e Y para que la distancia entera
+ * sea proporcional a la real. Con 16 bits cada punto ocupa 4
+ * bytes (vs 16 de dos double); con 32 bits, 8 bytes.
+ *
+ * En 32 bits se usan 30 bits de resolucion: asi el cuadrado
+ * de una diferencia (query incluido, ver fits()) cabe en 64
+ * bits sin desbordar.
+ *
+ * Las distancias enteras solo filtran candidatos. Redondear el
+ * punto y el query mueve la distancia a lo sumo sqrt(2) pasos,
+ * asi que todo punto que pueda estar en el resultado real cae
+ * dentro de QUANT_MARGIN pasos del mejor candidato entero; esos
+ * se refinan con los double exactos de 'pts'.
+ */
+template <typename T>
+struct QuantizedStore {
+    static constexpr long long LEVELS = sizeof(T) == 2 ? 0xFFFFLL : (1LL << 30) - 1;
+    double minX = 0, minY = 0, step = 1;
+    std::vector<T> qx, qy;
+
+    void build(const std::vector<Point>& pts) {
+        qx.clear(); qy.clear();
+        if (pts.empty()) return;
+        double maxX = pts[0].x, maxY = pts[0].y;
+        minX = pts[0].x; minY = pts[0].y;
+        for (const auto& p : pts) {
+            minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+        }
+        step = std::max(maxX - minX, maxY - minY) / (double)LEVELS;
+        if (step <= 0) step = 1;
+        qx.resize(pts.size()); qy.resize(pts.size());
+        for (size_t i = 0; i < pts.size(); ++i) {
+            qx[i] = (T)std::llround((pts[i].x - minX) / step);
+            qy[i] = (T)std::llround((pts[i].y - minY) / step);
+        }
+    }
+
+    // Coordenada cuantizada de un query (puede caer fuera de la caja)
+    double levelX(double x) const { return (x - minX) / step; }
+    double levelY(double y) const { return (y - minY) / step; }
+
+    // El kernel entero solo es seguro si el query esta a menos de
+    // una caja de distancia; si no, se usa el camino exacto.
+    bool fits(double x, double y) const {
+        double lx = levelX(x), ly = levelY(y);
+        return lx >= -LEVELS && lx <= 2.0 * LEVELS && ly >= -LEVELS && ly <= 2.0 * LEVELS;
+    }
+
+    unsigned long long dist2(int i, long long x, long long y) const {
+        long long dx = (long long)qx[i] - x, dy = (long long)qy[i] - y;
+        return (unsigned long long)(dx*dx) + (unsigned long long)(dy*dy);
+    }
+};
+
+// Umbral entero: todo lo que este a <= best + QUANT_MARGIN pasos
+inline unsigned long long quantThreshold(unsigned long long best2) {
+    double r = std::sqrt((double)best2) + QUANT_MARGIN;
+    return (unsigned long long)std::ceil(r * r);
+}
+
+/*
+ * k-NN con filtro entero. Pasada 1: heap con las k menores
+ * distancias enteras. Pasada 2: candidatos dentro del umbral,
+ * refinados con distancia exacta. Igual que kNN() se omiten los
+ * puntos con el mismo nombre que q; el nombre solo se compara
+ * cuando el candidato entraria al heap o pasa el umbral.
+ */
+template <typename T>
+std::vector<DistancePair> kNNCompact(const Point& q,
+                                     const std::vector<Point>& pts,
+                                     const QuantizedStore<T>& qs, int k) {
+    int n = (int)qs.qx.size();
+    if (k <= 0 || n != (int)pts.size() || !qs.fits(q.x, q.y)) return kNN(q, pts, k);
+    long long x = std::llround(qs.levelX(q.x)), y = std::llround(qs.levelY(q.y));
+
+    std::priority_queue<unsigned long long> heap;
+    for (int i = 0; i < n; ++i) {
+        unsigned long long d2 = qs.dist2(i, x, y);
+        bool full = (int)heap.size() >= k;
+        if (full && d2 >= heap.top()) continue;
+        if (pts[i].name == q.name) continue;
+        if (full) heap.pop();
+        heap.push(d2);
+    }
+    if (heap.empty()) return {};
+    unsigned long long lim = quantThreshold(heap.top());
+
+    std::vector<DistancePair> d;
+    for (int i = 0; i < n; ++i)
+        if (qs.dist2(i, x, y) <= lim && pts[i].name != q.name)
+            d.push_back({pts[i].name, euclideanDistance(q, pts[i])});
+    std::sort(d.begin(), d.end(),
+        [](const DistancePair& a, const DistancePair& b){ return a.distance < b.distance; });
+    if ((int)d.size() > k) d.resize(k);
+    return d;
+}
+
+/*
+ * K-Means sobre el almacenamiento compacto. La asignacion usa el
+ * kernel entero contra centroides cuantizados y solo refina con
+ * double los puntos con mas de un centroide dentro del margen
+ * (los que estan cerca de una frontera). Las sumas del paso M se
+ * hacen en enteros; los centroides finales se recalculan exactos
+ * desde 'pts' al terminar.
+ *
+ * Con k grande los centroides (en coordenadas de nivel, sin
+ * redondear) se indexan en un KdTree por iteracion: el mas
+ * cercano sale del indice y los candidatos del margen salen de
+ * una consulta por radio.
+ */
+template <typename T>
+std::vector<Group> kMeansCompact(std::vector<Point>& pts, int k, const QuantizedStore<T>& qs,
+                                 KMeansControl* ctl = nullptr) {
+    int n = (int)pts.size();
+    if (k <= 0 || n == 0) return {};
+    if (n != (int)qs.qx.size()) return kMeans(pts, k, ctl);
+    if (k > n) k = n;
+    std::mt19937 rng(42);
+    std::vector<Point> cents = kMeansPlusPlus(pts, k, rng, ctl);
+    if ((int)cents.size() < k) return {};   // cancelado durante la inicializacion
+    std::vector<int> assign(n, -1);
+    std::vector<long long> cx(k), cy(k);
+    std::vector<int> cand;
+    bool useIndex = k >= CENTROID_INDEX_MIN_K;
+    KdTree cIdx;
+    std::vector<Point> levels(useIndex ? k : 0);
+    for (int it = 0; it < MAX_ITER; ++it) {
+        for (int c = 0; c < k; ++c) {
+            cx[c] = std::llround(qs.levelX(cents[c].x));
+            cy[c] = std::llround(qs.levelY(cents[c].y));
+        }
+        if (useIndex) {
+            for (int c = 0; c < k; ++c) { levels[c].x = qs.levelX(cents[c].x); levels[c].y = qs.levelY(cents[c].y); }
+            cIdx.build(levels);
+        }
+        int changed = 0;
+        for (int i = 0; i < n; ++i) {
+            if (useIndex && !cIdx.empty()) {
+                double px = qs.qx[i], py = qs.qy[i];
+                auto nb = cIdx.nearest(px, py, 1);
+                int best = nb[0].second;
+                cand.clear();
+                cIdx.forEachInRadius(px, py, nb[0].first + QUANT_MARGIN,
+                                     [&](int c, double) { cand.push_back(c); });
+                if (cand.size() > 1) {
+                    double eD = std::numeric_limits<double>::max();
+                    for (int c : cand) { double d = euclideanDistance(pts[i], cents[c]); if (d < eD) { eD = d; best = c; } }
+                }
+                if (assign[i] != best) { assign[i] = best; changed++; }
+                continue;
+            }
+            unsigned long long bD = qs.dist2(i, cx[0], cy[0]);
+            int best = 0;
+            for (int c = 1; c < k; ++c) { unsigned long long d = qs.dist2(i, cx[c], cy[c]); if (d < bD) { bD = d; best = c; } }
+            unsigned long long lim = quantThreshold(bD);
+            cand.clear();
+            for (int c = 0; c < k; ++c) if (qs.dist2(i, cx[c], cy[c]) <= lim) cand.push_back(c);
+            if (cand.size() > 1) {
+                double eD = std::numeric_limits<double>::max();
+                for (int c : cand) { double d = euclideanDistance(pts[i], cents[c]); if (d < eD) { eD = d; best = c; } }
+            }
+            if (assign[i] != best) { assign[i] = best; changed++; }
+        }
+        if (kMeansStep(ctl, it, changed)) break;
+        std::vector<unsigned long long> sx(k,0), sy(k,0); std::vector<int> cnt(k,0);
+        for (int i = 0; i < n; ++i) { sx[assign[i]]+=qs.qx[i]; sy[assign[i]]+=qs.qy[i]; cnt[assign[i]]++; }
+        for (int c = 0; c < k; ++c) if (cnt[c]) {
+            cents[c].x = qs.minX + qs.step * ((double)sx[c] / cnt[c]);
+            cents[c].y = qs.minY + qs.step * ((double)sy[c] / cnt[c]);
+        }
+    }
+    // Resultado final exacto
+    std::vector<double> sx(k,0), sy(k,0); std::vector<int> cnt(k,0);
+    for (int i = 0; i < n; ++i) {
+        pts[i].groupId = assign[i];
+        sx[assign[i]] += pts[i].x; sy[assign[i]] += pts[i].y; cnt[assign[i]]++;
+    }
+    for (int c = 0; c < k; ++c) if (cnt[c]) { cents[c].x=sx[c]/cnt[c]; cents[c].y=sy[c]/cnt[c]; }
+    return buildGroups(cents);
+}
+
+// Modo compacto activo (0 = desactivado) y sus copias cuantizadas.
+// Se reconstruyen cuando cambia la epoca de datos o los bits.
+struct CompactStorage {
+    int bits = 0;
+    int builtBits = 0;
+    unsigned long long builtEpoch = 0;
+    QuantizedStore<uint16_t> s16;
+    QuantizedStore<uint32_t> s32;
+
+    void sync(const std::vector<Point>& pts, unsigned long long epoch) {
+        if (!bits || (bits == builtBits && epoch == builtEpoch)) return;
+        if (bits == 16) s16.build(pts); else s32.build(pts);
+        builtBits = bits; builtEpoch = epoch;
+    }
+    std::vector<DistancePair> kNN(const std::vector<Point>& pts, int idx, int k,
+                                  unsigned long long epoch) {
+        sync(pts, epoch);
+        if (bits == 16) return kNNCompact(pts[idx], pts, s16, k);
+        if (bits == 32) return kNNCompact(pts[idx], pts, s32, k);
+        return ::kNN(pts[idx], pts, k);
+    }
+    std::vector<Group> kMeans(std::vector<Point>& pts, int k, unsigned long long epoch,
+                              KMeansControl* ctl = nullptr) {
+        sync(pts, epoch);
+        if (bits == 16) return kMeansCompact(pts, k, s16, ctl);
+        if (bits == 32) return kMeansCompact(pts, k, s32, ctl);
+        return ::kMeans(pts, k, ctl);
+    }
+};
+
+// ============================================================
+//  DBSCAN  (consultas por radio en KdTree)  O(n log n) tipico
+// ============================================================
+/*
+ * Agrupa por densidad: un punto es "nucleo" si tiene al menos
+ * minPts puntos (contandose a si mismo) a distancia <= eps.
+ * Los nucleos conectados por distancias <= eps forman un grupo;
+ * los no-nucleo a menos de eps de un nucleo son "borde" y se
+ * unen al grupo del nucleo mas cercano; el resto es ruido
+ * (groupId = -1). Un punto con coordenadas no finitas no esta
+ * en el indice y queda como ruido.
+ *
+ * Cada consulta de vecindario es una busqueda por radio eps en
+ * el KdTree: O(log n + m) tipico con m vecinos, sin importar lo
+ * dispersos que esten los demas puntos. La expansion de nucleos
+ * se hace en paralelo con un union-find atomico: cada raiz se
+ * enlaza a la raiz de menor indice mediante compare-exchange,
+ * lo que evita ciclos sin necesidad de locks.
+ */
+int ufFind(std::vector<std::atomic<int>>& par, int i) {
+    while (true) {
+        int p = par[i].load();
+        if (p == i) return i;
+        int gp = par[p].load();
+        par[i].compare_exchange_weak(p, gp);   // path halving
+        i = gp;
+    }
+}
+
+void ufUnion(std::vector<std::atomic<int>>& par, int a, int b) {
+    while (true) {
+        a = ufFind(par, a); b = ufFind(par, b);
+        if (a == b) return;
+        if (a < b) std::swap(a, b);
+        int expected = a;
+        if (par[a].compare_exchange_strong(expected, b)) return;
+    }
+}
+
+std::vector<Group> dbscan(std::vector<Point>& pts, double eps, int minPts) {
+    int n = (int)pts.size();
+    if (n == 0 || eps <= 0) return {};
+    if (minPts < 1) minPts = 1;
+    KdTree tree;
+    tree.build(pts);
+
+    // 1. Marcar nucleos (los puntos no finitos no se consultan)
+    std::vector<char> core(n, 0);
+    parallelFor(n, [&](int i) {
+        if (!std::isfinite(pts[i].x) || !std::isfinite(pts[i].y)) return;
+        int cnt = 0;
+        tree.forEachInRadius(pts[i].x, pts[i].y, eps, [&](int, double) { ++cnt; });
+        core[i] = (cnt >= minPts);
+    });
+
+    // 2. Unir nucleos vecinos (paralelo)
+    std::vector<std::atomic<int>> par(n);
+    for (int i = 0; i < n; ++i) par[i].store(i);
+    parallelFor(n, [&](int i) {
+        if (!core[i]) return;
+        tree.forEachInRadius(pts[i].x, pts[i].y, eps, [&](int j, double) {
+            if (j > i && core[j]) ufUnion(par, i, j);
+        });
+    });
+
+    // 3. Etiquetar: nucleo -> su raiz, borde -> raiz del nucleo mas cercano
+    std::vector<int> root(n, -1);
+    parallelFor(n, [&](int i) {
+        if (core[i]) { root[i] = ufFind(par, i); return; }
+        if (!std::isfinite(pts[i].x) || !std::isfinite(pts[i].y)) return;
+        int best = -1; double bD = 0;
+        tree.forEachInRadius(pts[i].x, pts[i].y, eps, [&](int j, double d2) {
+            if (!core[j]) return;
+            if (best < 0 || d2 < bD || (d2 == bD && j < best)) { best = j; bD = d2; }
+        });
+        if (best >= 0) root[i] = ufFind(par, best);
+    });
+
+    // 4. Numerar grupos en orden de aparicion y calcular centroides
+    std::vector<int> idOf(n, -1);
+    std::vector<double> sx, sy; std::vector<int> cnt;
+    for (int i = 0; i < n; ++i) {
+        if (root[i] < 0) { pts[i].groupId = -1; continue; }
+        int& id = idOf[root[i]];
+        if (id < 0) { id = (int)cnt.size(); sx.push_back(0); sy.push_back(0); cnt.push_back(0); }
+        pts[i].groupId = id;
+        sx[id] += pts[i].x; sy[id] += pts[i].y; cnt[id]++;
+    }
+    std::vector<Point> cents;
+    for (int c = 0; c < (int)cnt.size(); ++c) cents.push_back(Point("", sx[c]/cnt[c], sy[c]/cnt[c]));
+    return buildGroups(cents);
 }
 
 // ============================================================
-//  CLASIFICACION  O(k)
+//  CLASIFICACION  O(k), o sublineal con indice de centroides
 // ============================================================
-int classifyPoint(const Point& q, const std::vector<Group>& gs) {
+/*
+ * Con 'idx' (KdTree sobre los centroides, ver
+ * buildCentroidIndex) el centroide mas cercano sale del indice;
+ * sin el, se recorren los k centroides.
+ */
+void buildCentroidIndex(KdTree& idx, const std::vector<Group>& gs) {
+    if ((int)gs.size() < CENTROID_INDEX_MIN_K) { idx = KdTree(); return; }
+    std::vector<Point> cents;
+    cents.reserve(gs.size());
+    for (const auto& g : gs) cents.push_back(g.centroid);
+    idx.build(cents);
+}
+
+int classifyPoint(const Point& q, const std::vector<Group>& gs,
+                  const KdTree* idx = nullptr) {
+    if (idx && !idx->empty()) return idx->nearest(q.x, q.y, 1)[0].second;
     int best = 0; double bD = euclideanDistance(q, gs[0].centroid);
     for (int i = 1; i < (int)gs.size(); ++i) {
         double d = euclideanDistance(q, gs[i].centroid);
@@ -334,6 +993,387 @@ int classifyPoint(const Point& q, const std::vector<Group>& gs) {
     return best;
 }
 
+// ============================================================
+//  CACHE DE CONSULTAS (LRU + EPOCAS)
+// ============================================================
+/*
+ * Guarda los ultimos QUERY_CACHE_SIZE resultados de k-NN
+ * (clave "n:<nombre>") y de clasificacion (clave "c:<x>,<y>").
+ * Cada entrada recuerda la epoca con la que se calculo: main
+ * sube 'dataEpoch' al agregar/eliminar puntos y 'clusterEpoch'
+ * con cada clustering. Una entrada de otra epoca se descarta al
+ * consultarla, asi invalidar cuesta O(1).
+ *
+ * k-NN se guarda con su k: un pedido con k' <= k se responde
+ * con el prefijo de la lista ya ordenada.
+ */
+struct QueryCache {
+    struct Entry {
+        unsigned long long epoch;
+        int k;
+        std::vector<DistancePair> nb;
+        int groupId;
+    };
+    typedef std::list<std::pair<std::string, Entry>> LruList;
+    LruList lru;                                            // frente = mas reciente
+    std::unordered_map<std::string, LruList::iterator> where;
+    long long hits = 0, misses = 0;
+
+    Entry* lookup(const std::string& key, unsigned long long epoch) {
+        auto it = where.find(key);
+        if (it == where.end()) return nullptr;
+        if (it->second->second.epoch != epoch) {
+            lru.erase(it->second); where.erase(it);
+            return nullptr;
+        }
+        lru.splice(lru.begin(), lru, it->second);
+        return &it->second->second;
+    }
+
+    void store(const std::string& key, Entry e) {
+        auto it = where.find(key);
+        if (it != where.end()) { lru.erase(it->second); where.erase(it); }
+        lru.emplace_front(key, std::move(e));
+        where[key] = lru.begin();
+        if ((int)lru.size() > QUERY_CACHE_SIZE) {
+            where.erase(lru.back().first);
+            lru.pop_back();
+        }
+    }
+
+    bool getKNN(const std::string& key, int k, unsigned long long epoch,
+                std::vector<DistancePair>& out) {
+        Entry* e = lookup(key, epoch);
+        if (!e || e->k < k) { misses++; return false; }
+        out.assign(e->nb.begin(), e->nb.begin() + std::min(k, (int)e->nb.size()));
+        hits++;
+        return true;
+    }
+    void putKNN(const std::string& key, int k, unsigned long long epoch,
+                const std::vector<DistancePair>& nb) {
+        store(key, {epoch, k, nb, -1});
+    }
+
+    bool getClass(const std::string& key, unsigned long long epoch, int& gid) {
+        Entry* e = lookup(key, epoch);
+        if (!e) { misses++; return false; }
+        gid = e->groupId;
+        hits++;
+        return true;
+    }
+    void putClass(const std::string& key, unsigned long long epoch, int gid) {
+        store(key, {epoch, 0, {}, gid});
+    }
+
+    double hitRate() const {
+        long long total = hits + misses;
+        return total ? 100.0 * hits / total : 0.0;
+    }
+};
+
+std::string coordKey(double x, double y) {
+    std::ostringstream os;
+    os << "c:" << std::setprecision(17) << x << "," << y;
+    return os.str();
+}
+
+// ============================================================
+//  IMPORTACION MASIVA DE ARCHIVO  name,x,y
+// ============================================================
+/*
+ * Lee el archivo completo a memoria y lo corta en bloques de
+ * ~IMPORT_CHUNK_BYTES, siempre terminando en un '\n'. Cada
+ * bloque se parsea en paralelo con std::from_chars (sin
+ * locale ni copias); los nombres quedan como string_view sobre
+ * el buffer. Despues, en una sola pasada secuencial, se
+ * descartan nombres repetidos con un hash set (incluidos los
+ * que ya estaban en 'pts') y se agregan los nuevos.
+ *
+ * Lineas vacias y las que empiezan con '#' se ignoran; si la
+ * primera linea no tiene coordenadas se toma como encabezado.
+ */
+struct ImportStats {
+    long long added = 0, duplicates = 0, invalid = 0;
+    size_t bytes = 0;
+    double ms = 0;
+};
+
+struct ParsedRow {
+    std::string_view name;
+    double x, y;
+};
+
+std::string_view trimView(std::string_view v) {
+    while (!v.empty() && (v.front() == ' ' || v.front() == '\t')) v.remove_prefix(1);
+    while (!v.empty() && (v.back() == ' ' || v.back() == '\t' || v.back() == '\r')) v.remove_suffix(1);
+    return v;
+}
+
+// Coordenada decimal finita (from_chars acepta "inf" y "nan": se rechazan)
+bool parseCoord(std::string_view v, double& out) {
+    v = trimView(v);
+    if (!v.empty() && v.front() == '+') v.remove_prefix(1);
+    if (v.empty()) return false;
+    auto r = std::from_chars(v.data(), v.data() + v.size(), out);
+    return r.ec == std::errc() && r.ptr == v.data() + v.size() && std::isfinite(out);
+}
+
+// Parsea una linea "name,x,y". Devuelve false si no es valida.
+bool parseRow(std::string_view line, ParsedRow& row) {
+    size_t c1 = line.find(',');
+    if (c1 == std::string_view::npos) return false;
+    size_t c2 = line.find(',', c1 + 1);
+    if (c2 == std::string_view::npos) return false;
+    row.name = trimView(line.substr(0, c1));
+    return !row.name.empty()
+        && parseCoord(line.substr(c1 + 1, c2 - c1 - 1), row.x)
+        && parseCoord(line.substr(c2 + 1), row.y);
+}
+
+bool importPointsFile(const std::string& path, std::vector<Point>& pts, ImportStats& st) {
+    auto t0 = std::chrono::steady_clock::now();
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    f.seekg(0, std::ios::end);
+    std::streamoff size = f.tellg();
+    f.seekg(0);
+    // Un directorio se "abre" pero tellg() da -1 o un tamano absurdo
+    // y no se puede leer: se prueba un byte antes de reservar memoria
+    if (size < 0 || (size > 0 && f.peek() == std::char_traits<char>::eof())) return false;
+    std::string buf((size_t)size, '\0');
+    f.read(&buf[0], (std::streamsize)buf.size());
+    if (f.gcount() != (std::streamsize)buf.size()) return false;
+    st = ImportStats();
+    st.bytes = buf.size();
+
+    // Limites de bloque alineados a fin de linea
+    std::vector<size_t> cuts{0};
+    while (cuts.back() < buf.size()) {
+        size_t c = std::min(buf.size(), cuts.back() + IMPORT_CHUNK_BYTES);
+        while (c < buf.size() && buf[c-1] != '\n') ++c;
+        cuts.push_back(c);
+    }
+    int nChunks = (int)cuts.size() - 1;
+
+    std::vector<std::vector<ParsedRow>> rows(nChunks);
+    std::vector<long long> bad(nChunks, 0);
+    std::string_view all(buf);
+    parallelFor(nChunks, [&](int ch) {
+        std::string_view v = all.substr(cuts[ch], cuts[ch+1] - cuts[ch]);
+        bool first = (ch == 0);
+        ParsedRow row;
+        while (!v.empty()) {
+            size_t nl = v.find('\n');
+            std::string_view line = v.substr(0, nl);
+            v.remove_prefix(nl == std::string_view::npos ? v.size() : nl + 1);
+            line = trimView(line);
+            if (line.empty() || line.front() == '#') continue;
+            if (parseRow(line, row)) rows[ch].push_back(row);
+            else if (!first)         bad[ch]++;
+            first = false;
+        }
+    }, 1);
+
+    // Deduplicado + construccion del almacen en una pasada
+    size_t total = 0;
+    for (int ch = 0; ch < nChunks; ++ch) { total += rows[ch].size(); st.invalid += bad[ch]; }
+    pts.reserve(pts.size() + total);   // sin realocar: las vistas a pts[i].name siguen validas
+    std::unordered_set<std::string_view> seen;
+    seen.reserve(pts.size() + total);
+    for (const auto& p : pts) seen.insert(p.name);
+    for (int ch = 0; ch < nChunks; ++ch)
+        for (const auto& r : rows[ch]) {
+            if (!seen.insert(r.name).second) { st.duplicates++; continue; }
+            pts.emplace_back(std::string(r.name), r.x, r.y);
+            st.added++;
+        }
+    st.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return true;
+}
+
+// ============================================================
+//  EJECUCION ASINCRONA (CORUTINAS C++20 SOBRE UN POOL DE HILOS)
+// ============================================================
+/*
+ * ThreadPool: hilos fijos que reanudan corutinas. Una corutina
+ * hace 'co_await pool.schedule()' para pasar a un hilo del pool
+ * (y lo repite entre bloques de trabajo para ceder el hilo).
+ * AsyncJob es el tipo de retorno "lanzar y olvidar": arranca al
+ * llamarla y su frame se libera solo al terminar. Los resultados
+ * se publican en un estado compartido (shared_ptr) que el hilo
+ * principal revisa antes de cada prompt.
+ *
+ * Al destruir el pool los hilos terminan sin tomar mas trabajo
+ * y las corutinas que quedaron en cola se destruyen.
+ */
+struct ThreadPool {
+    std::vector<std::thread> workers;
+    std::queue<std::coroutine_handle<>> jobs;
+    std::mutex m;
+    std::condition_variable cv;
+    bool stop = false;
+
+    explicit ThreadPool(int n) {
+        for (int i = 0; i < n; ++i) workers.emplace_back([this]() { run(); });
+    }
+    ~ThreadPool() {
+        { std::lock_guard<std::mutex> lk(m); stop = true; }
+        cv.notify_all();
+        for (auto& w : workers) w.join();
+        while (!jobs.empty()) { jobs.front().destroy(); jobs.pop(); }
+    }
+
+    void run() {
+        while (true) {
+            std::coroutine_handle<> h;
+            {
+                std::unique_lock<std::mutex> lk(m);
+                cv.wait(lk, [this]() { return stop || !jobs.empty(); });
+                if (stop) return;
+                h = jobs.front(); jobs.pop();
+            }
+            h.resume();
+        }
+    }
+
+    void post(std::coroutine_handle<> h) {
+        { std::lock_guard<std::mutex> lk(m); jobs.push(h); }
+        cv.notify_one();
+    }
+
+    auto schedule() {
+        struct Awaiter {
+            ThreadPool* pool;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { pool->post(h); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{this};
+    }
+};
+
+struct AsyncJob {
+    struct promise_type {
+        AsyncJob get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+/*
+ * Carga en segundo plano: lee el archivo por bloques de
+ * IMPORT_CHUNK_BYTES, parsea cada bloque y deja los puntos en
+ * 'ready'. El hilo principal los integra a 'pts' antes de cada
+ * prompt (drainAsyncLoad), asi las consultas ya responden sobre
+ * la parte cargada mientras el resto sigue leyendose.
+ *
+ * 'names' y 'namesEpoch' solo los usa el hilo principal: el set
+ * de nombres se reconstruye desde 'pts' si los puntos cambiaron
+ * por otra via (la epoca de datos ya no coincide).
+ */
+struct AsyncLoad {
+    std::string path;
+    std::mutex m;
+    std::vector<Point> ready;
+    std::atomic<long long> parsed{0}, invalid{0};
+    std::atomic<bool> done{false}, failed{false}, cancel{false};
+
+    std::unordered_set<std::string> names;
+    unsigned long long namesEpoch = ~0ULL;
+    long long added = 0, duplicates = 0;
+};
+
+AsyncJob loadFileAsync(ThreadPool& pool, std::shared_ptr<AsyncLoad> st) {
+    co_await pool.schedule();
+    std::ifstream f(st->path, std::ios::binary);
+    f.peek();   // un directorio se abre pero no se puede leer (badbit)
+    if (!f || f.bad()) { st->failed = true; st->done = true; co_return; }
+    std::string buf, carry;
+    bool first = true;
+    while (f && !st->cancel) {
+        buf.assign(carry);
+        size_t old = buf.size();
+        buf.resize(old + IMPORT_CHUNK_BYTES);
+        f.read(&buf[old], IMPORT_CHUNK_BYTES);
+        if (f.bad()) { st->failed = true; break; }
+        buf.resize(old + (size_t)f.gcount());
+        // Lo que queda despues del ultimo '\n' pasa al siguiente bloque
+        size_t cut = f ? buf.rfind('\n') : buf.size();
+        if (cut == std::string::npos) { carry.swap(buf); continue; }
+        if (cut < buf.size()) cut++;
+        carry.assign(buf, cut, std::string::npos);
+
+        std::vector<Point> batch;
+        std::string_view v(buf.data(), cut);
+        ParsedRow row;
+        while (!v.empty()) {
+            size_t nl = v.find('\n');
+            std::string_view line = trimView(v.substr(0, nl));
+            v.remove_prefix(nl == std::string_view::npos ? v.size() : nl + 1);
+            if (line.empty() || line.front() == '#') continue;
+            if (parseRow(line, row)) batch.emplace_back(std::string(row.name), row.x, row.y);
+            else if (!first)         st->invalid++;
+            first = false;
+        }
+        st->parsed += (long long)batch.size();
+        {
+            std::lock_guard<std::mutex> lk(st->m);
+            if (st->ready.empty()) st->ready.swap(batch);
+            else st->ready.insert(st->ready.end(), std::make_move_iterator(batch.begin()),
+                                  std::make_move_iterator(batch.end()));
+        }
+        co_await pool.schedule();   // cede el hilo entre bloques
+    }
+    st->done = true;
+}
+
+// Integra a 'pts' los puntos listos (hilo principal). Devuelve
+// cuantos se agregaron; si hubo alguno sube la epoca de datos.
+long long drainAsyncLoad(AsyncLoad& st, std::vector<Point>& pts, unsigned long long& dataEpoch) {
+    std::vector<Point> batch;
+    { std::lock_guard<std::mutex> lk(st.m); batch.swap(st.ready); }
+    if (batch.empty()) return 0;
+    if (st.namesEpoch != dataEpoch) {
+        st.names.clear();
+        for (const auto& p : pts) st.names.insert(p.name);
+    }
+    long long added = 0;
+    for (auto& p : batch) {
+        if (!st.names.insert(p.name).second) { st.duplicates++; continue; }
+        pts.push_back(std::move(p));
+        added++;
+    }
+    st.added += added;
+    if (added) ++dataEpoch;
+    st.namesEpoch = dataEpoch;
+    return added;
+}
+
+/*
+ * K-Means en segundo plano sobre una copia de los puntos. El
+ * resultado solo se aplica si la epoca de datos no cambio
+ * mientras corria (ver main).
+ */
+struct AsyncCluster {
+    std::vector<Point> pts;
+    std::vector<Group> gs;
+    int k = 0, bits = 0;
+    unsigned long long epoch = 0;          // dataEpoch al lanzar
+    unsigned long long clusterEpoch = 0;   // clusterEpoch al lanzar
+    KMeansControl ctl;
+    std::atomic<bool> done{false};
+};
+
+AsyncJob kMeansAsync(ThreadPool& pool, std::shared_ptr<AsyncCluster> job) {
+    co_await pool.schedule();
+    CompactStorage cs;
+    cs.bits = job->bits;
+    job->gs = cs.kMeans(job->pts, job->k, job->epoch, &job->ctl);
+    job->done = true;
+}
+
 // ============================================================
 //  UTILIDADES
 // ============================================================
@@ -342,14 +1382,18 @@ int findPoint(const std::vector<Point>& pts, const std::string& nm) {
     return -1;
 }
 
-// Devuelve string con los nombres de todos los puntos
+// Devuelve string con los nombres de los puntos (los primeros
+// NAMES_PREVIEW si el dataset es grande)
 std::string pointNamesList(const std::vector<Point>& pts) {
     if (pts.empty()) return "(ninguno)";
     std::string s;
-    for (int i = 0; i < (int)pts.size(); ++i) {
+    int shown = std::min((int)pts.size(), NAMES_PREVIEW);
+    for (int i = 0; i < shown; ++i) {
         if (i) s += ", ";
         s += pts[i].name;
     }
+    if (shown < (int)pts.size())
+        s += ", ... (+" + std::to_string(pts.size() - shown) + ")";
     return s;
 }
 
@@ -388,16 +1432,36 @@ void printHeader() {
  * usuario escribe 'h' o '?'.
  */
 void printStatus(const std::vector<Point>& pts,
-                 const std::vector<Group>& gs) {
+                 const std::vector<Group>& gs,
+                 const CompactStorage& cs,
+                 const QueryCache& cache,
+                 const AsyncLoad* load,
+                 const AsyncCluster* kjob) {
     sep('-', 46);
     std::cout << "  Puntos: " << pts.size();
     if (!gs.empty()) std::cout << "  |  Grupos: " << gs.size();
     else             std::cout << "  |  Sin clustering";
+    if (cs.bits)     std::cout << "  |  Compacto " << cs.bits << "b";
     std::cout << "\n";
     if (!pts.empty()) std::cout << "  -> " << pointNamesList(pts) << "\n";
+    if (cache.hits + cache.misses > 0) {
+        std::ostringstream rate;
+        rate << std::fixed << std::setprecision(1) << cache.hitRate();
+        std::cout << "  Cache: " << cache.hits << "/" << (cache.hits + cache.misses)
+                  << " aciertos (" << rate.str() << "%)\n";
+    }
+    if (load)
+        std::cout << "  Carga en curso: " << load->parsed << " puntos leidos de '"
+                  << load->path << "'\n";
+    if (kjob)
+        std::cout << "  K-Means (2do plano): iteracion " << kjob->ctl.iteration
+                  << ", " << kjob->ctl.moved << " cambios  [x]Cancelar\n";
     sep('-', 46);
     std::cout << "  [1]Agregar [2]Eliminar [3]Listar [4]Ver plano\n";
     std::cout << "  [5]Dist    [6]k-NN     [7]Cluster [8]Clasificar\n";
+    std::cout << "  [p]Par min [g]Grafo k-NN [d]DBSCAN\n";
+    std::cout << "  [q]Compacto [i]Importar\n";
+    std::cout << "  [a]Cargar (2do plano) [k]K-Means (2do plano)\n";
     std::cout << "  [9]Demo    [h]Ayuda    [0]Salir\n";
     sep('-', 46);
     std::cout << "  > ";
@@ -413,16 +1477,34 @@ void printHelp() {
     std::cout << "  1  Agregar punto        Nombre + X + Y\n";
     std::cout << "     (calcula vecino mas cercano automaticamente)\n\n";
     std::cout << "  2  Eliminar punto       Por nombre\n\n";
+    std::cout << "  i  Importar archivo     Lineas 'nombre,x,y'\n";
+    std::cout << "     (parseo paralelo, omite nombres repetidos)\n\n";
     std::cout << "  3  Listar puntos        Tabla con coords y grupo\n\n";
     std::cout << "  4  Ver plano            Dibuja el plano ASCII\n";
     std::cout << "     '.' = interseccion de grilla\n";
     std::cout << "     '+' = cruce con eje\n";
     std::cout << "     Letras/simbolos = puntos del dataset\n\n";
     std::cout << "  5  Distancia            Euclidiana entre 2 puntos\n\n";
-    std::cout << "  6  k-NN                 k vecinos mas cercanos\n\n";
-    std::cout << "  7  Clustering K-Means   Agrupar en k grupos\n\n";
+    std::cout << "  6  k-NN                 k vecinos mas cercanos\n";
+    std::cout << "     (resultados repetidos salen de la cache)\n\n";
+    std::cout << "  p  Par mas cercano      Divide y venceras\n";
+    std::cout << "     O(n log n) sobre todo el dataset\n\n";
+    std::cout << "  g  Grafo k-NN           k vecinos de cada punto\n";
+    std::cout << "     (paralelo, se puede escribir a archivo)\n\n";
+    std::cout << "  7  Clustering K-Means   Agrupar en k grupos\n";
+    std::cout << "     (hasta " << MAX_GROUPS << "; los simbolos se repiten)\n\n";
+    std::cout << "  d  Clustering DBSCAN    Por densidad (eps, minPts)\n";
+    std::cout << "     no requiere k; puntos aislados = ruido\n\n";
     std::cout << "  8  Clasificar           Asigna nuevo punto a grupo\n";
     std::cout << "     (requiere haber hecho clustering antes)\n\n";
+    std::cout << "  q  Modo compacto        Coordenadas en 16/32 bits\n";
+    std::cout << "     (filtro entero para k-NN y K-Means)\n\n";
+    std::cout << "  a  Cargar archivo       Igual que 'i' pero en 2do plano:\n";
+    std::cout << "     los puntos se agregan por bloques y se\n";
+    std::cout << "     pueden consultar mientras sigue la carga\n\n";
+    std::cout << "  k  K-Means 2do plano    No bloquea el menu; el avance\n";
+    std::cout << "     se ve en la barra de estado\n";
+    std::cout << "  x  Cancelar K-Means     Detiene el K-Means en 2do plano\n\n";
     std::cout << "  9  Demo automatico      15 puntos, 3 clusters\n\n";
     std::cout << "  0  Salir\n";
     sep('=', 46);
@@ -479,13 +1561,62 @@ void runDemo(std::vector<Point>& pts, std::vector<Group>& gs) {
 int main() {
     std::vector<Point> pts;
     std::vector<Group> gs;
+    CompactStorage compact;
+    KdTree centroidIdx;      // indice de centroides para la opcion 8
+    QueryCache cache;
+    unsigned long long dataEpoch = 0;     // sube al cambiar los puntos
+    unsigned long long clusterEpoch = 0;  // sube al cambiar los grupos
+    ThreadPool pool(std::max(POOL_MIN_THREADS, (int)std::thread::hardware_concurrency()));
+    std::shared_ptr<AsyncLoad> load;      // carga en 2do plano (si hay)
+    std::shared_ptr<AsyncCluster> kjob;   // K-Means en 2do plano (si hay)
 
     printHeader();
     std::cout << "  Escribe 'h' para ver la ayuda completa.\n\n";
 
     std::string input;
     while (true) {
-        printStatus(pts, gs);
+        // --- Integrar lo que avanzaron los trabajos en 2do plano ---
+        if (load) {
+            bool finished = load->done;   // leer antes de vaciar 'ready'
+            if (drainAsyncLoad(*load, pts, dataEpoch) > 0 && !gs.empty()) {
+                ++clusterEpoch;
+                gs.clear();
+                for (auto& p : pts) p.groupId = -1;
+            }
+            if (finished) {
+                if (load->failed)
+                    std::cout << "  [!] No se pudo leer '" << load->path << "'.\n";
+                else {
+                    std::cout << "  [OK] Carga de '" << load->path << "' terminada: "
+                              << load->added << " punto(s) agregado(s)";
+                    if (load->duplicates) std::cout << ", " << load->duplicates << " repetido(s)";
+                    if (load->invalid)    std::cout << ", " << load->invalid << " linea(s) invalida(s)";
+                    std::cout << "\n";
+                }
+                load.reset();
+            }
+        }
+        if (kjob && kjob->done) {
+            if (kjob->ctl.cancel)
+                std::cout << "  [!] K-Means en 2do plano cancelado.\n";
+            else if (kjob->epoch != dataEpoch || kjob->clusterEpoch != clusterEpoch)
+                std::cout << "  [!] K-Means en 2do plano descartado: los puntos o los grupos cambiaron.\n";
+            else {
+                for (int i = 0; i < (int)pts.size(); ++i) pts[i].groupId = kjob->pts[i].groupId;
+                gs = std::move(kjob->gs);
+                ++clusterEpoch;
+                buildCentroidIndex(centroidIdx, gs);
+                std::cout << "  [OK] K-Means en 2do plano listo: " << gs.size() << " grupo(s), ";
+                if (kjob->ctl.converged)
+                    std::cout << "convergio en " << kjob->ctl.iteration << " iteracion(es).\n";
+                else
+                    std::cout << "sin converger tras " << MAX_ITER << " iteraciones.\n";
+                std::cout << "  Usa [4] para ver el plano.\n";
+            }
+            kjob.reset();
+        }
+
+        printStatus(pts, gs, compact, cache, load.get(), kjob.get());
         std::getline(std::cin, input);
 
         // Normalizar: tomar primer caracter no espacio
@@ -494,6 +1625,8 @@ int main() {
 
         // --------------------------------------------------------
         if (cmd == '0') {
+            if (load) load->cancel = true;
+            if (kjob) kjob->ctl.cancel = true;
             std::cout << "\n  Hasta pronto!\n\n";
             break;
 
@@ -527,6 +1660,7 @@ int main() {
             }
             Point np(name, x, y);
             pts.push_back(np);
+            ++dataEpoch;
             std::cout << "  [OK] Punto '" << name << "' en (" << x << ", " << y << ") agregado.\n";
             // k-NN automatico
             if (pts.size() > 1) {
@@ -536,10 +1670,83 @@ int main() {
                           << nn[0].distance << ")\n";
             }
             // Invalidar clustering previo
+            ++clusterEpoch;
             gs.clear();
             for (auto& p : pts) p.groupId = -1;
             pausar();
 
+        // --------------------------------------------------------
+        } else if (cmd == 'i' || cmd == 'I') {
+            sep();
+            std::cout << "  -- IMPORTAR ARCHIVO (nombre,x,y) --\n";
+            std::cout << "  Ruta: ";
+            std::string fn; std::getline(std::cin, fn);
+            fn.erase(0,fn.find_first_not_of(" \t")); fn.erase(fn.find_last_not_of(" \t")+1);
+            if (fn.empty()) { std::cout << "  Cancelado.\n"; continue; }
+            ImportStats st;
+            if (!importPointsFile(fn, pts, st)) {
+                std::cout << "  [!] No se pudo abrir '" << fn << "'.\n"; pausar(); continue;
+            }
+            std::cout << "  [OK] " << st.added << " punto(s) agregado(s)";
+            if (st.duplicates) std::cout << ", " << st.duplicates << " repetido(s)";
+            if (st.invalid)    std::cout << ", " << st.invalid << " linea(s) invalida(s)";
+            double mb = st.bytes / (1024.0 * 1024.0);
+            std::cout << "\n  " << std::fixed << std::setprecision(2) << mb << " MB en "
+                      << st.ms << " ms";
+            if (st.ms > 0) std::cout << "  (" << mb / (st.ms / 1000.0) << " MB/s)";
+            std::cout << "\n";
+            if (st.added) {
+                ++dataEpoch; ++clusterEpoch;
+                gs.clear();
+                for (auto& p : pts) p.groupId = -1;
+            }
+            pausar();
+
+        // --------------------------------------------------------
+        } else if (cmd == 'a' || cmd == 'A') {
+            if (load) { std::cout << "  [!] Ya hay una carga en curso.\n"; pausar(); continue; }
+            sep();
+            std::cout << "  -- CARGAR ARCHIVO EN 2DO PLANO (nombre,x,y) --\n";
+            std::cout << "  Ruta: ";
+            std::string fn; std::getline(std::cin, fn);
+            fn.erase(0,fn.find_first_not_of(" \t")); fn.erase(fn.find_last_not_of(" \t")+1);
+            if (fn.empty()) { std::cout << "  Cancelado.\n"; continue; }
+            load = std::make_shared<AsyncLoad>();
+            load->path = fn;
+            loadFileAsync(pool, load);
+            std::cout << "  [OK] Carga iniciada. Los puntos apareceran a medida que se lean.\n";
+
+        // --------------------------------------------------------
+        } else if (cmd == 'k' || cmd == 'K') {
+            if (kjob) { std::cout << "  [!] Ya hay un K-Means en curso (x = cancelar).\n"; pausar(); continue; }
+            if (pts.empty()) { std::cout << "  [!] Sin puntos.\n"; pausar(); continue; }
+            sep();
+            std::cout << "  -- K-MEANS EN 2DO PLANO --\n";
+            int maxK = std::min((int)pts.size(), MAX_GROUPS);
+            std::cout << "  Numero de grupos k (1 - " << maxK << "): ";
+            std::string sk; std::getline(std::cin, sk);
+            int k = 2;
+            try { k = std::stoi(sk); } catch(...) {}
+            if (k < 1 || k > maxK) {
+                std::cout << "  [!] k debe estar entre 1 y " << maxK << ".\n";
+                pausar(); continue;
+            }
+            kjob = std::make_shared<AsyncCluster>();
+            kjob->pts = pts;
+            for (auto& p : kjob->pts) p.groupId = -1;
+            kjob->k = k;
+            kjob->bits = compact.bits;
+            kjob->epoch = dataEpoch;
+            kjob->clusterEpoch = clusterEpoch;
+            kMeansAsync(pool, kjob);
+            std::cout << "  [OK] K-Means iniciado; el avance se ve en la barra de estado.\n";
+
+        // --------------------------------------------------------
+        } else if (cmd == 'x' || cmd == 'X') {
+            if (!kjob) { std::cout << "  [!] No hay K-Means en curso.\n"; continue; }
+            kjob->ctl.cancel = true;
+            std::cout << "  Cancelando K-Means (termina la iteracion en curso)...\n";
+
         // --------------------------------------------------------
         } else if (cmd == '2') {
             if (pts.empty()) { std::cout << "  [!] No hay puntos.\n"; pausar(); continue; }
@@ -553,6 +1760,7 @@ int main() {
             int idx = findPoint(pts, name);
             if (idx < 0) { std::cout << "  [!] No encontrado.\n"; pausar(); continue; }
             pts.erase(pts.begin() + idx);
+            ++dataEpoch; ++clusterEpoch;
             gs.clear();
             for (auto& p : pts) p.groupId = -1;
             std::cout << "  [OK] '" << name << "' eliminado.\n";
@@ -607,8 +1815,64 @@ int main() {
             if (k < 1) k = 1;
             int maxK = (int)pts.size() - 1;
             if (k > maxK) k = maxK;
-            auto nn = kNN(pts[idx], pts, k);
+            std::string key = "n:" + pts[idx].name;
+            std::vector<DistancePair> nn;
+            bool hit = cache.getKNN(key, k, dataEpoch, nn);
+            if (!hit) {
+                nn = compact.kNN(pts, idx, k, dataEpoch);
+                cache.putKNN(key, k, dataEpoch, nn);
+            }
             printKNN(pts[idx], nn);
+            if (hit) std::cout << "  (desde cache)\n";
+            pausar();
+
+        // --------------------------------------------------------
+        } else if (cmd == 'p' || cmd == 'P') {
+            if (pts.size() < 2) { std::cout << "  [!] Necesitas al menos 2 puntos.\n"; pausar(); continue; }
+            sep();
+            std::cout << "  -- PAR MAS CERCANO --\n";
+            auto t0 = std::chrono::steady_clock::now();
+            ClosestPairResult cp = closestPair(pts);
+            double ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - t0).count();
+            reportNonFinite(pts);
+            if (cp.a < 0) { std::cout << "  [!] Necesitas al menos 2 puntos con coordenadas finitas.\n"; pausar(); continue; }
+            std::cout << "\n  " << pts[cp.a].name << " (" << std::fixed << std::setprecision(2)
+                      << pts[cp.a].x << ", " << pts[cp.a].y << ")  <->  "
+                      << pts[cp.b].name << " (" << pts[cp.b].x << ", " << pts[cp.b].y << ")\n";
+            std::cout << "  d = " << std::setprecision(6) << cp.distance
+                      << "   [" << std::setprecision(2) << ms << " ms, n = " << pts.size() << "]\n";
+            pausar();
+
+        // --------------------------------------------------------
+        } else if (cmd == 'g' || cmd == 'G') {
+            if (pts.size() < 2) { std::cout << "  [!] Necesitas al menos 2 puntos.\n"; pausar(); continue; }
+            sep();
+            std::cout << "  -- GRAFO k-NN (TODOS LOS PUNTOS) --\n";
+            std::cout << "  k (vecinos por punto): ";
+            std::string sk; std::getline(std::cin, sk);
+            int k = 1;
+            try { k = std::stoi(sk); } catch(...) { k = 1; }
+            if (k < 1) k = 1;
+            std::cout << "  Archivo de salida (vacio = pantalla): ";
+            std::string fn; std::getline(std::cin, fn);
+            fn.erase(0,fn.find_first_not_of(" \t")); fn.erase(fn.find_last_not_of(" \t")+1);
+            auto t0 = std::chrono::steady_clock::now();
+            long long edges = 0;
+            if (fn.empty()) {
+                std::cout << "\n";
+                edges = writeKNNGraph(pts, k, std::cout);
+            } else {
+                std::ofstream f(fn);
+                if (!f) { std::cout << "  [!] No se pudo abrir '" << fn << "'.\n"; pausar(); continue; }
+                edges = writeKNNGraph(pts, k, f);
+            }
+            double ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - t0).count();
+            reportNonFinite(pts);
+            std::cout << "  [OK] " << edges << " aristas";
+            if (!fn.empty()) std::cout << " escritas en '" << fn << "'";
+            std::cout << "  [" << std::fixed << std::setprecision(2) << ms << " ms]\n";
             pausar();
 
         // --------------------------------------------------------
@@ -616,7 +1880,7 @@ int main() {
             if (pts.empty()) { std::cout << "  [!] Sin puntos.\n"; pausar(); continue; }
             sep();
             std::cout << "  -- CLUSTERING K-MEANS --\n";
-            int maxK = std::min((int)pts.size(), (int)GROUP_SYMBOLS.size());
+            int maxK = std::min((int)pts.size(), MAX_GROUPS);
             std::cout << "  Numero de grupos k (1 - " << maxK << "): ";
             std::string sk; std::getline(std::cin, sk);
             int k = 2;
@@ -626,24 +1890,55 @@ int main() {
                 pausar(); continue;
             }
             for (auto& p : pts) p.groupId = -1;
-            gs = kMeans(pts, k);
+            gs = compact.kMeans(pts, k, dataEpoch);
+            ++clusterEpoch;
+            buildCentroidIndex(centroidIdx, gs);
             printClusterStats(pts, gs);
             drawPlane(pts, gs, "K-MEANS CLUSTERING");
             pausar();
 
+        // --------------------------------------------------------
+        } else if (cmd == 'd' || cmd == 'D') {
+            if (pts.empty()) { std::cout << "  [!] Sin puntos.\n"; pausar(); continue; }
+            sep();
+            std::cout << "  -- CLUSTERING DBSCAN --\n";
+            std::cout << "  eps (radio de vecindario): ";
+            std::string se; std::getline(std::cin, se);
+            double eps = 0;
+            try { eps = std::stod(se); } catch(...) {}
+            if (eps <= 0) { std::cout << "  [!] eps debe ser mayor que 0.\n"; pausar(); continue; }
+            std::cout << "  minPts (minimo de vecinos, def. 4): ";
+            std::string sm; std::getline(std::cin, sm);
+            int minPts = 4;
+            try { minPts = std::stoi(sm); } catch(...) {}
+            if (minPts < 1) minPts = 1;
+            gs = dbscan(pts, eps, minPts);
+            ++clusterEpoch;
+            reportNonFinite(pts);
+            buildCentroidIndex(centroidIdx, gs);
+            int noise = 0;
+            for (auto& p : pts) if (p.groupId < 0) noise++;
+            std::cout << "  DBSCAN: " << gs.size() << " grupo(s), " << noise << " punto(s) de ruido\n";
+            printClusterStats(pts, gs);
+            drawPlane(pts, gs, "DBSCAN CLUSTERING");
+            pausar();
+
         // --------------------------------------------------------
         } else if (cmd == '8') {
             if (gs.empty()) {
-                std::cout << "  [!] Ejecuta primero el clustering (opcion 7).\n";
+                std::cout << "  [!] Ejecuta primero el clustering (opcion 7 o d).\n";
                 pausar(); continue;
             }
             sep();
             std::cout << "  -- CLASIFICAR NUEVO PUNTO --\n";
             std::cout << "  Grupos disponibles:\n";
-            for (int i = 0; i < (int)gs.size(); ++i)
+            int shownG = std::min((int)gs.size(), NAMES_PREVIEW);
+            for (int i = 0; i < shownG; ++i)
                 std::cout << "    [" << gs[i].symbol << "] " << gs[i].name
                           << "  centroide=(" << std::fixed << std::setprecision(2)
                           << gs[i].centroid.x << ", " << gs[i].centroid.y << ")\n";
+            if (shownG < (int)gs.size())
+                std::cout << "    ... (+" << gs.size() - shownG << " grupos)\n";
             std::cout << "  Nombre del nuevo punto: ";
             std::string name; std::getline(std::cin, name);
             name.erase(0,name.find_first_not_of(" \t")); name.erase(name.find_last_not_of(" \t")+1);
@@ -656,17 +1951,42 @@ int main() {
                 std::cout << "  [!] Coordenadas invalidas.\n"; pausar(); continue;
             }
             Point np(name, x, y);
-            int gid = classifyPoint(np, gs);
+            std::string key = coordKey(x, y);
+            int gid = 0;
+            if (!cache.getClass(key, clusterEpoch, gid)) {
+                gid = classifyPoint(np, gs, &centroidIdx);
+                cache.putClass(key, clusterEpoch, gid);
+            }
             np.groupId = gid;
             pts.push_back(np);
+            ++dataEpoch;
             std::cout << "\n  >> '" << name << "' clasificado en: "
                       << gs[gid].name << "  [" << gs[gid].symbol << "]\n";
             drawPlane(pts, gs, "CLASIFICACION: " + name);
             pausar();
 
+        // --------------------------------------------------------
+        } else if (cmd == 'q' || cmd == 'Q') {
+            sep();
+            std::cout << "  -- MODO COMPACTO --\n";
+            std::cout << "  Actual: " << (compact.bits ? std::to_string(compact.bits) + " bits" : "desactivado") << "\n";
+            std::cout << "  Bits por coordenada (0 = off, 16, 32): ";
+            std::string sb; std::getline(std::cin, sb);
+            int bits = -1;
+            try { bits = std::stoi(sb); } catch(...) {}
+            if (bits != 0 && bits != 16 && bits != 32) {
+                std::cout << "  [!] Valor invalido.\n"; pausar(); continue;
+            }
+            compact.bits = bits;
+            if (bits) std::cout << "  [OK] k-NN y K-Means usaran coordenadas de " << bits << " bits.\n";
+            else      std::cout << "  [OK] Modo compacto desactivado.\n";
+            pausar();
+
         // --------------------------------------------------------
         } else if (cmd == '9') {
             runDemo(pts, gs);
+            ++dataEpoch; ++clusterEpoch;
+            buildCentroidIndex(centroidIdx, gs);
 
         // --------------------------------------------------------
         } else if (cmd != 0) {
@@ -682,9 +2002,16 @@ int main() {
  * ============================================================
  *  euclideanDistance : O(1)
  *  k-NN              : O(n log n)
+ *  Par mas cercano   : O(n log n)
+ *  Grafo k-NN (kd)   : O(n * (log n + k log k)) tipico, paralelo
  *  K-Means (Lloyd)   : O(I * k * n),  I <= 300
  *  K-Means++ init    : O(k * n)
- *  Clasificacion     : O(k)
+ *  DBSCAN (kd)       : O(n log n) tipico, paralelo
+ *  Clasificacion     : O(k), O(log k) tipico con indice (k >= 32)
+ *  Importar archivo  : O(bytes / hilos) + O(n) deduplicado
+ *  k-NN compacto     : O(n) filtro entero + refinado de candidatos
  *  drawPlane         : O(W * H)
+ *  Trabajos en 2do plano (carga, K-Means): mismos costos, sin
+ *  bloquear el menu; se integran antes de cada prompt
  * ============================================================
  */